@@ -0,0 +1,125 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_8de42df9_e94d_4247_9832_b3405624a459
+#define included_8de42df9_e94d_4247_9832_b3405624a459
+
+#include <iterator>
+#include <utility>
+#include <vector>
+
+#include "error_or.hpp"
+
+namespace acm {
+
+    namespace detail {
+
+        template<typename Iterator>
+        struct error_or_range_traits {
+            using error_or_type = typename std::iterator_traits<Iterator>::value_type;
+            using error_type = typename error_or_type::error_type;
+            using value_type = typename error_or_type::value_type;
+        };
+
+    } // namespace detail
+
+    // Returns an iterator to the first element of [first, last) that
+    // holds an error, or last if every element holds a value. Usable in
+    // constant expressions under C++14.
+    template<typename InputIterator>
+    ACM_RELAXED_CONSTEXPR InputIterator first_error(InputIterator first, InputIterator last) {
+        for (; first != last; ++first)
+            if (!first->ok())
+                break;
+        return first;
+    }
+
+    // Gathers the values of [first, last) into a single vector, or
+    // returns the first error. The output is sized exactly before any
+    // value is moved, so at most one allocation is made. Values, or the
+    // error, are moved out of the range with release_value and
+    // release_error, leaving the elements in a moved-from state.
+    template<typename ForwardIterator>
+    auto collect(ForwardIterator first, ForwardIterator last)
+        -> error_or<typename detail::error_or_range_traits<ForwardIterator>::error_type,
+                    std::vector<typename detail::error_or_range_traits<ForwardIterator>::value_type>> {
+
+        using traits = detail::error_or_range_traits<ForwardIterator>;
+        using values_type = std::vector<typename traits::value_type>;
+        using result_type = error_or<typename traits::error_type, values_type>;
+
+        auto const failed = first_error(first, last);
+        if (failed != last)
+            return result_type(failed->release_error());
+
+        values_type values;
+        values.reserve(static_cast<typename values_type::size_type>(std::distance(first, last)));
+        for (; first != last; ++first)
+            values.push_back(first->release_value());
+        return result_type(std::move(values));
+    }
+
+    // Splits [first, last) into its values and its errors, preserving
+    // the relative order of each. A counting pass sizes both outputs
+    // exactly, and every element is moved out of the range.
+    template<typename ForwardIterator>
+    auto partition_results(ForwardIterator first, ForwardIterator last)
+        -> std::pair<std::vector<typename detail::error_or_range_traits<ForwardIterator>::value_type>,
+                     std::vector<typename detail::error_or_range_traits<ForwardIterator>::error_type>> {
+
+        using traits = detail::error_or_range_traits<ForwardIterator>;
+
+        typename std::iterator_traits<ForwardIterator>::difference_type total = 0, ok = 0;
+        for (auto current = first; current != last; ++current, ++total)
+            if (current->ok())
+                ++ok;
+
+        std::pair<std::vector<typename traits::value_type>,
+                  std::vector<typename traits::error_type>> result;
+        result.first.reserve(static_cast<std::size_t>(ok));
+        result.second.reserve(static_cast<std::size_t>(total - ok));
+
+        for (; first != last; ++first) {
+            if (first->ok())
+                result.first.push_back(first->release_value());
+            else
+                result.second.push_back(first->release_error());
+        }
+        return result;
+    }
+
+    // Reorders [first, last) so that every element holding a value
+    // precedes every element holding an error, and returns an iterator
+    // to the first error. Nothing is allocated: elements are swapped
+    // within the input buffer. Values keep their relative order; errors
+    // may not.
+    template<typename ForwardIterator>
+    ForwardIterator partition_results_in_place(ForwardIterator first, ForwardIterator last) {
+        first = first_error(first, last);
+        if (first == last)
+            return first;
+
+        for (auto current = std::next(first); current != last; ++current) {
+            if (current->ok()) {
+                using std::swap;
+                swap(*first, *current);
+                ++first;
+            }
+        }
+        return first;
+    }
+
+} // namespace acm
+
+#endif // included_8de42df9_e94d_4247_9832_b3405624a459
@@ -0,0 +1,130 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares collect, partition_results and partition_results_in_place
+// against naive loops that grow their output and copy values.
+//
+// Usage: algorithms_bench [max_exponent]
+//
+// Ranges of 10^3 up to 10^max_exponent elements (default 7) are
+// measured at several error ratios. Errors are scattered uniformly, so
+// collect usually stops early once errors are present; the 0 ratio row
+// is the one that exercises the full copy.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../algorithms.hpp"
+
+using namespace acm;
+
+namespace {
+
+    using clock = std::chrono::steady_clock;
+    using element = error_code_or<std::string>;
+
+    volatile std::size_t sink;
+
+    std::vector<element> make_input(std::size_t size, double error_ratio) {
+        std::mt19937 engine(static_cast<std::mt19937::result_type>(size));
+        std::bernoulli_distribution is_error(error_ratio);
+        std::vector<element> input;
+        input.reserve(size);
+        for (std::size_t i = 0; i != size; ++i) {
+            if (is_error(engine))
+                input.push_back(element(std::make_error_code(std::errc::io_error)));
+            else
+                input.push_back(element(std::string("value")));
+        }
+        return input;
+    }
+
+    error_code_or<std::vector<std::string>> naive_collect(std::vector<element> const& input) {
+        std::vector<std::string> values;
+        for (auto const& e : input) {
+            if (!e)
+                return e.error();
+            values.push_back(e.value());
+        }
+        return values;
+    }
+
+    std::pair<std::vector<std::string>, std::vector<std::error_code>> naive_partition(std::vector<element> const& input) {
+        std::pair<std::vector<std::string>, std::vector<std::error_code>> result;
+        for (auto const& e : input) {
+            if (e)
+                result.first.push_back(e.value());
+            else
+                result.second.push_back(e.error());
+        }
+        return result;
+    }
+
+    // Builds a fresh input for each run, since the algorithms under test
+    // consume it, and times only the operation itself.
+    template<typename Operation>
+    double time_ms(std::size_t size, double error_ratio, Operation operation) {
+        auto input = make_input(size, error_ratio);
+        auto const start = clock::now();
+        operation(input);
+        auto const end = clock::now();
+        return std::chrono::duration<double, std::milli>(end - start).count();
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    int const max_exponent = argc > 1 ? std::atoi(argv[1]) : 7;
+    double const error_ratios[] = { 0.0, 0.001, 0.1, 0.5 };
+
+    std::printf("%10s %8s %14s %14s %14s %14s %14s\n", "size", "errors",
+                "naive_collect", "collect", "naive_part", "partition", "in_place");
+
+    std::size_t size = 1000;
+    for (int exponent = 3; exponent <= max_exponent; ++exponent, size *= 10) {
+        for (double const ratio : error_ratios) {
+            double const naive_collect_ms = time_ms(size, ratio, [](std::vector<element>& input) {
+                auto result = naive_collect(input);
+                sink = result ? result.value().size() : 0;
+            });
+            double const collect_ms = time_ms(size, ratio, [](std::vector<element>& input) {
+                auto result = collect(input.begin(), input.end());
+                sink = result ? result.value().size() : 0;
+            });
+            double const naive_partition_ms = time_ms(size, ratio, [](std::vector<element>& input) {
+                auto result = naive_partition(input);
+                sink = result.first.size() + result.second.size();
+            });
+            double const partition_ms = time_ms(size, ratio, [](std::vector<element>& input) {
+                auto result = partition_results(input.begin(), input.end());
+                sink = result.first.size() + result.second.size();
+            });
+            double const in_place_ms = time_ms(size, ratio, [](std::vector<element>& input) {
+                auto split = partition_results_in_place(input.begin(), input.end());
+                sink = static_cast<std::size_t>(split - input.begin());
+            });
+
+            std::printf("%10zu %8.3f %14.3f %14.3f %14.3f %14.3f %14.3f\n", size, ratio,
+                        naive_collect_ms, collect_ms, naive_partition_ms, partition_ms, in_place_ms);
+        }
+    }
+
+    std::printf("(times in milliseconds)\n");
+    return EXIT_SUCCESS;
+}
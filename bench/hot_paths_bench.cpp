@@ -0,0 +1,259 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measures hardware events per operation on the error_or hot paths.
+//
+// Usage: hot_paths_bench [--csv] [iterations]
+//
+// The default output is a human readable table. With --csv, one line
+// per scenario is written in a stable column order suitable for
+// tracking regressions between releases; counters the kernel refused
+// to open are left empty.
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#include "../converters.hpp"
+#include "perf_counters.hpp"
+
+using namespace acm;
+using acm::bench::perf_counters;
+
+namespace {
+
+    // Quiet stand-ins for the Foo types in examples/foo.hpp, which
+    // print from every special member and would swamp the counters.
+    struct Payload {
+        std::unique_ptr<int> token;
+        Payload() : token(new int(17)) {}
+    };
+
+    struct PayloadNoExcept {
+        std::unique_ptr<int> token;
+        PayloadNoExcept() noexcept : token(new(std::nothrow) int(17)) {}
+    };
+
+    volatile long sink;
+
+    template<typename T, typename... Args>
+    std::unique_ptr<T> make_unique(Args&&... args)
+    {
+        return std::unique_ptr<T>(new T(std::forward<Args>(args)...));
+    }
+
+    template<typename T>
+    error_code_or<T> maybe_make_a_t(int val) __attribute__((noinline));
+
+    template<typename T>
+    error_code_or<T> maybe_make_a_t(int val) {
+        if (val <= 0)
+            return std::make_error_code(std::errc::invalid_argument);
+        return T();
+    }
+
+    template<typename T>
+    void use_a_t(int val) __attribute__((noinline));
+
+    template<typename T>
+    void use_a_t(int val) {
+        auto result = maybe_make_a_t<T>(val);
+        if (result) {
+            T t = result.release_value();
+            (void)t;
+            sink = sink + 1;
+        } else {
+            sink = sink + result.error().value();
+        }
+    }
+
+    template<typename T>
+    error_code_or_unique<T> maybe_make_a_new_t(int val) __attribute__((noinline));
+
+    template<typename T>
+    error_code_or_unique<T> maybe_make_a_new_t(int val) {
+        if (val <= 0)
+            return std::make_error_code(std::errc::invalid_argument);
+        return make_unique<T>();
+    }
+
+    template<typename T>
+    void use_a_new_t(int val) __attribute__((noinline));
+
+    template<typename T>
+    void use_a_new_t(int val) {
+        auto result = maybe_make_a_new_t<T>(val);
+        if (result) {
+            std::unique_ptr<T> new_t = result.release_value();
+            sink = sink + 1;
+        } else {
+            sink = sink + result.error().value();
+        }
+    }
+
+    int sometimes_throws_system_error(int val) {
+        if (val <= 0)
+            throw std::system_error(std::make_error_code(std::errc::invalid_argument));
+        return val;
+    }
+
+    error_code_or<int> sometimes_returns_error_code(int val) {
+        if (val <= 0)
+            return std::make_error_code(std::errc::invalid_argument);
+        return val;
+    }
+
+    // Converts a throwing call to a returning one and back again, so
+    // that each operation pays for both adapters.
+    std::function<int(int)> const round_trip_from_throw =
+        return2throw(throw2return(std::function<int(int)>(sometimes_throws_system_error)));
+
+    std::function<error_code_or<int>(int)> const round_trip_from_return =
+        throw2return(return2throw(std::function<error_code_or<int>(int)>(sometimes_returns_error_code)));
+
+    void use_round_trip_from_throw(int val) __attribute__((noinline));
+
+    void use_round_trip_from_throw(int val) {
+        try {
+            sink = sink + round_trip_from_throw(val);
+        } catch (std::system_error const& xcp) {
+            sink = sink + xcp.code().value();
+        }
+    }
+
+    void use_round_trip_from_return(int val) __attribute__((noinline));
+
+    void use_round_trip_from_return(int val) {
+        auto result = round_trip_from_return(val);
+        if (result)
+            sink = sink + result.value();
+        else
+            sink = sink + result.error().value();
+    }
+
+    struct scenario {
+        char const* name;
+        void (*op)(int);
+        int arg;
+    };
+
+    scenario const scenarios[] = {
+        { "use_a_t<int>/value",                   use_a_t<int>,                    1 },
+        { "use_a_t<int>/error",                   use_a_t<int>,                    0 },
+        { "use_a_t<Payload>/value",               use_a_t<Payload>,                1 },
+        { "use_a_t<Payload>/error",               use_a_t<Payload>,                0 },
+        { "use_a_t<PayloadNoExcept>/value",       use_a_t<PayloadNoExcept>,        1 },
+        { "use_a_t<PayloadNoExcept>/error",       use_a_t<PayloadNoExcept>,        0 },
+        { "use_a_new_t<Payload>/value",           use_a_new_t<Payload>,            1 },
+        { "use_a_new_t<Payload>/error",           use_a_new_t<Payload>,            0 },
+        { "use_a_new_t<PayloadNoExcept>/value",   use_a_new_t<PayloadNoExcept>,    1 },
+        { "use_a_new_t<PayloadNoExcept>/error",   use_a_new_t<PayloadNoExcept>,    0 },
+        { "return2throw(throw2return)/value",     use_round_trip_from_throw,       1 },
+        { "return2throw(throw2return)/error",     use_round_trip_from_throw,       0 },
+        { "throw2return(return2throw)/value",     use_round_trip_from_return,      1 },
+        { "throw2return(return2throw)/error",     use_round_trip_from_return,      0 },
+    };
+
+    void run(scenario const& s, perf_counters& counters, long iterations) {
+        // The argument is laundered through a volatile so that the
+        // compiler cannot specialize the operation for a known branch.
+        volatile int arg = s.arg;
+
+        // Warm the caches and branch predictors before measuring.
+        for (long i = 0; i != iterations / 10 + 1; ++i)
+            s.op(arg);
+
+        counters.start();
+        for (long i = 0; i != iterations; ++i)
+            s.op(arg);
+        counters.stop();
+    }
+
+    void print_table_header(perf_counters const& counters) {
+        std::printf("%-40s %12s", "scenario", "ns/op");
+        for (int c = 0; c != perf_counters::num_counters; ++c)
+            std::printf(" %14s", perf_counters::name(static_cast<perf_counters::counter>(c)));
+        std::printf("\n");
+        if (!counters.any_available())
+            std::printf("# hardware counters unavailable; reporting wall clock time only\n");
+    }
+
+    void print_table_row(scenario const& s, perf_counters const& counters, long iterations) {
+        std::printf("%-40s %12.2f", s.name, static_cast<double>(counters.elapsed().count()) / iterations);
+        for (int c = 0; c != perf_counters::num_counters; ++c) {
+            auto const counter = static_cast<perf_counters::counter>(c);
+            if (counters.available(counter))
+                std::printf(" %14.2f", static_cast<double>(counters.value(counter)) / iterations);
+            else
+                std::printf(" %14s", "n/a");
+        }
+        std::printf("\n");
+    }
+
+    void print_csv_header() {
+        std::printf("scenario,iterations,ns_per_op");
+        for (int c = 0; c != perf_counters::num_counters; ++c)
+            std::printf(",%s_per_op", perf_counters::name(static_cast<perf_counters::counter>(c)));
+        std::printf("\n");
+    }
+
+    void print_csv_row(scenario const& s, perf_counters const& counters, long iterations) {
+        std::printf("%s,%ld,%.4f", s.name, iterations, static_cast<double>(counters.elapsed().count()) / iterations);
+        for (int c = 0; c != perf_counters::num_counters; ++c) {
+            auto const counter = static_cast<perf_counters::counter>(c);
+            if (counters.available(counter))
+                std::printf(",%.4f", static_cast<double>(counters.value(counter)) / iterations);
+            else
+                std::printf(",");
+        }
+        std::printf("\n");
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    bool csv = false;
+    long iterations = 1000000;
+
+    for (int i = 1; i != argc; ++i) {
+        if (std::strcmp(argv[i], "--csv") == 0)
+            csv = true;
+        else
+            iterations = std::atol(argv[i]);
+    }
+
+    if (iterations <= 0) {
+        std::fprintf(stderr, "usage: %s [--csv] [iterations]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    perf_counters counters;
+
+    if (csv)
+        print_csv_header();
+    else
+        print_table_header(counters);
+
+    for (auto const& s : scenarios) {
+        run(s, counters, iterations);
+        if (csv)
+            print_csv_row(s, counters, iterations);
+        else
+            print_table_row(s, counters, iterations);
+    }
+
+    return EXIT_SUCCESS;
+}
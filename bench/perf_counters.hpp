@@ -0,0 +1,195 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_5d0f4c7e_2b8a_4e31_9a6c_e3f1b07d92a4
+#define included_5d0f4c7e_2b8a_4e31_9a6c_e3f1b07d92a4
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__linux__)
+#include <cstring>
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace acm {
+namespace bench {
+
+    // A small wrapper around perf_event_open that counts user space
+    // hardware events for the calling thread. Each counter is opened
+    // independently, so a PMU that lacks one event (L1i misses are
+    // frequently missing under virtualization) still reports the
+    // others. On platforms without perf_event_open, or when the kernel
+    // refuses access, counters simply report as unavailable and only
+    // wall clock time is measured.
+    class perf_counters final {
+
+    public:
+        enum counter {
+            cycles,
+            instructions,
+            branch_misses,
+            l1i_misses,
+            num_counters
+        };
+
+        static char const* name(counter c) noexcept {
+            static char const* const names[num_counters] = {
+                "cycles",
+                "instructions",
+                "branch_misses",
+                "l1i_misses",
+            };
+            return names[c];
+        }
+
+        inline perf_counters() noexcept {
+            for (int c = 0; c != num_counters; ++c) {
+                fds_[c] = open_counter(static_cast<counter>(c));
+                values_[c] = 0;
+                valid_[c] = true;
+            }
+        }
+
+        perf_counters(perf_counters const&) = delete;
+        perf_counters& operator=(perf_counters const&) = delete;
+
+        inline ~perf_counters() noexcept {
+#if defined(__linux__)
+            for (int c = 0; c != num_counters; ++c)
+                if (fds_[c] != -1)
+                    ::close(fds_[c]);
+#endif
+        }
+
+        // True if the counter opened and produced a count in the most
+        // recent start/stop run. Before the first run, true if it opened.
+        inline bool available(counter c) const noexcept {
+            return fds_[c] != -1 and valid_[c];
+        }
+
+        inline bool any_available() const noexcept {
+            for (int c = 0; c != num_counters; ++c)
+                if (available(static_cast<counter>(c)))
+                    return true;
+            return false;
+        }
+
+        inline void start() noexcept {
+#if defined(__linux__)
+            for (int c = 0; c != num_counters; ++c) {
+                if (fds_[c] != -1) {
+                    ::ioctl(fds_[c], PERF_EVENT_IOC_RESET, 0);
+                    ::ioctl(fds_[c], PERF_EVENT_IOC_ENABLE, 0);
+                }
+            }
+#endif
+            start_ = clock::now();
+        }
+
+        inline void stop() noexcept {
+            auto const end = clock::now();
+#if defined(__linux__)
+            for (int c = 0; c != num_counters; ++c) {
+                if (fds_[c] == -1)
+                    continue;
+                ::ioctl(fds_[c], PERF_EVENT_IOC_DISABLE, 0);
+
+                // With TOTAL_TIME_ENABLED and TOTAL_TIME_RUNNING the
+                // kernel reports how long the event was actually
+                // scheduled, which lets us scale the count up if the
+                // PMU was multiplexed.
+                // A counter that opened but was never scheduled, which
+                // is common under virtualization, has no meaningful
+                // count for this run and is reported as unavailable.
+                std::uint64_t buf[3] = {};
+                if (::read(fds_[c], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)) or buf[2] == 0) {
+                    values_[c] = 0;
+                    valid_[c] = false;
+                    continue;
+                }
+                valid_[c] = true;
+                values_[c] = (buf[2] == buf[1]) ? buf[0] :
+                    static_cast<std::uint64_t>(static_cast<double>(buf[0]) * buf[1] / buf[2]);
+            }
+#endif
+            elapsed_ = end - start_;
+        }
+
+        inline std::uint64_t value(counter c) const noexcept {
+            return values_[c];
+        }
+
+        inline std::chrono::nanoseconds elapsed() const noexcept {
+            return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed_);
+        }
+
+    private:
+        using clock = std::chrono::steady_clock;
+
+        static int open_counter(counter c) noexcept {
+#if defined(__linux__)
+            perf_event_attr attr;
+            std::memset(&attr, 0, sizeof(attr));
+            attr.size = sizeof(attr);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+            switch (c) {
+            case cycles:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_CPU_CYCLES;
+                break;
+            case instructions:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_INSTRUCTIONS;
+                break;
+            case branch_misses:
+                attr.type = PERF_TYPE_HARDWARE;
+                attr.config = PERF_COUNT_HW_BRANCH_MISSES;
+                break;
+            case l1i_misses:
+                attr.type = PERF_TYPE_HW_CACHE;
+                attr.config = PERF_COUNT_HW_CACHE_L1I |
+                    (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                    (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+                break;
+            default:
+                return -1;
+            }
+
+            long const fd = ::syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+            return fd < 0 ? -1 : static_cast<int>(fd);
+#else
+            (void)c;
+            return -1;
+#endif
+        }
+
+        int fds_[num_counters];
+        std::uint64_t values_[num_counters];
+        bool valid_[num_counters];
+        clock::time_point start_;
+        clock::duration elapsed_ = clock::duration::zero();
+    };
+
+} // namespace bench
+} // namespace acm
+
+#endif // included_5d0f4c7e_2b8a_4e31_9a6c_e3f1b07d92a4
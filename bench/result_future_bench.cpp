@@ -0,0 +1,230 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares result_future against std::future at high task rates.
+//
+// Usage: result_future_bench [tasks] [error_percent] [threads]
+//
+// Every task returns error_code_or<int>, failing for error_percent of
+// them. The same small thread pool runs the tasks for result_promise
+// and for std::promise, where a failure has to become an exception_ptr.
+// std::async, which starts a thread per task, is shown for reference.
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../result_future.hpp"
+
+using namespace acm;
+
+namespace {
+
+    using clock = std::chrono::steady_clock;
+
+    class thread_pool final {
+
+    public:
+        explicit thread_pool(unsigned threads) {
+            for (unsigned i = 0; i != threads; ++i)
+                workers_.emplace_back([this]() { run(); });
+        }
+
+        ~thread_pool() {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                stopping_ = true;
+            }
+            cv_.notify_all();
+            for (auto& worker : workers_)
+                worker.join();
+        }
+
+        void submit(std::function<void()> task) {
+            {
+                std::lock_guard<std::mutex> lock(mutex_);
+                tasks_.push_back(std::move(task));
+            }
+            cv_.notify_one();
+        }
+
+    private:
+        void run() {
+            for (;;) {
+                std::function<void()> task;
+                {
+                    std::unique_lock<std::mutex> lock(mutex_);
+                    cv_.wait(lock, [this]() { return stopping_ or !tasks_.empty(); });
+                    if (tasks_.empty())
+                        return;
+                    task = std::move(tasks_.front());
+                    tasks_.pop_front();
+                }
+                task();
+            }
+        }
+
+        std::mutex mutex_;
+        std::condition_variable cv_;
+        std::deque<std::function<void()>> tasks_;
+        std::vector<std::thread> workers_;
+        bool stopping_ = false;
+    };
+
+    int error_percent;
+
+    error_code_or<int> task(int i) {
+        if (i % 100 < error_percent)
+            return std::make_error_code(std::errc::io_error);
+        return i;
+    }
+
+    int task_or_throw(int i) {
+        auto result = task(i);
+        if (!result)
+            throw std::system_error(result.release_error());
+        return result.release_value();
+    }
+
+    long run_result_future(thread_pool& pool, int tasks) {
+        std::vector<error_code_future<int>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i != tasks; ++i) {
+            auto promise = std::make_shared<error_code_promise<int>>();
+            futures.push_back(promise->get_future());
+            pool.submit([promise, i]() { promise->set_result(task(i)); });
+        }
+        long sum = 0;
+        for (auto& f : futures) {
+            auto result = f.get();
+            sum += result ? result.value() : -1;
+        }
+        return sum;
+    }
+
+    long run_result_future_then(thread_pool& pool, int tasks) {
+        std::vector<error_code_future<int>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i != tasks; ++i) {
+            auto promise = std::make_shared<error_code_promise<int>>();
+            futures.push_back(promise->get_future().then([](error_code_or<int> r) { return r; }));
+            pool.submit([promise, i]() { promise->set_result(task(i)); });
+        }
+        long sum = 0;
+        for (auto& f : futures) {
+            auto result = f.get();
+            sum += result ? result.value() : -1;
+        }
+        return sum;
+    }
+
+    long run_std_future(thread_pool& pool, int tasks) {
+        std::vector<std::future<int>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i != tasks; ++i) {
+            auto promise = std::make_shared<std::promise<int>>();
+            futures.push_back(promise->get_future());
+            pool.submit([promise, i]() {
+                try {
+                    promise->set_value(task_or_throw(i));
+                } catch (...) {
+                    promise->set_exception(std::current_exception());
+                }
+            });
+        }
+        long sum = 0;
+        for (auto& f : futures) {
+            try {
+                sum += f.get();
+            } catch (std::system_error const&) {
+                sum += -1;
+            }
+        }
+        return sum;
+    }
+
+    long run_std_async(int tasks) {
+        std::vector<std::future<int>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i != tasks; ++i)
+            futures.push_back(std::async(std::launch::async, task_or_throw, i));
+        long sum = 0;
+        for (auto& f : futures) {
+            try {
+                sum += f.get();
+            } catch (std::system_error const&) {
+                sum += -1;
+            }
+        }
+        return sum;
+    }
+
+    long run_when_all(thread_pool& pool, int tasks) {
+        std::vector<error_code_future<int>> futures;
+        futures.reserve(tasks);
+        for (int i = 0; i != tasks; ++i) {
+            auto promise = std::make_shared<error_code_promise<int>>();
+            futures.push_back(promise->get_future());
+            pool.submit([promise, i]() { promise->set_result(task(i)); });
+        }
+        auto all = when_all(std::move(futures)).get();
+        return all ? static_cast<long>(all.value().size()) : -1;
+    }
+
+    template<typename Run>
+    void report(char const* name, int tasks, Run run) {
+        auto const start = clock::now();
+        long const sum = run();
+        double const ns = std::chrono::duration<double, std::nano>(clock::now() - start).count();
+        std::printf("%-28s %12.1f %14.0f %14ld\n", name, ns / tasks, tasks / ns * 1e9, sum);
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    int const tasks = argc > 1 ? std::atoi(argv[1]) : 200000;
+    error_percent = argc > 2 ? std::atoi(argv[2]) : 10;
+    unsigned const threads = argc > 3 ? std::atoi(argv[3]) : 4;
+
+    if (tasks <= 0 or threads == 0) {
+        std::fprintf(stderr, "usage: %s [tasks] [error_percent] [threads]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    std::printf("%d tasks, %d%% errors, %u pool threads\n", tasks, error_percent, threads);
+    std::printf("%-28s %12s %14s %14s\n", "", "ns/task", "tasks/s", "checksum");
+
+    {
+        thread_pool pool(threads);
+        report("result_future", tasks, [&]() { return run_result_future(pool, tasks); });
+        report("result_future.then", tasks, [&]() { return run_result_future_then(pool, tasks); });
+        report("std::future", tasks, [&]() { return run_std_future(pool, tasks); });
+        report("when_all", tasks, [&]() { return run_when_all(pool, tasks); });
+    }
+
+    // A thread per task; keep the count modest.
+    int const async_tasks = tasks < 20000 ? tasks : 20000;
+    report("std::async", async_tasks, [&]() { return run_std_async(async_tasks); });
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,124 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares the latency distribution of retry_on_transient against a
+// conventional fixed sleep retry loop.
+//
+// Usage: retry_bench [samples] [mean_busy_us] [fixed_sleep_us]
+//
+// Each sample calls an operation that fails with EAGAIN until a
+// resource becomes free. The time until the resource frees is drawn
+// from an exponential distribution with the given mean, which models
+// short lived contention. The reported latency is from the first
+// attempt to the first success.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "../converters.hpp"
+
+using namespace acm;
+
+namespace {
+
+    using clock = std::chrono::steady_clock;
+
+    clock::time_point busy_until;
+
+    error_code_or<int> try_acquire(int token) {
+        if (clock::now() < busy_until)
+            return std::make_error_code(std::errc::resource_unavailable_try_again);
+        return token;
+    }
+
+    error_code_or<int> fixed_sleep_retry(int token, std::chrono::microseconds interval) {
+        for (;;) {
+            auto result = try_acquire(token);
+            if (result or result.error() != std::errc::resource_unavailable_try_again)
+                return result;
+            std::this_thread::sleep_for(interval);
+        }
+    }
+
+    template<typename Acquire>
+    std::vector<double> measure(Acquire acquire, std::vector<std::chrono::nanoseconds> const& busy) {
+        std::vector<double> latencies;
+        latencies.reserve(busy.size());
+        for (std::size_t i = 0; i != busy.size(); ++i) {
+            auto const start = clock::now();
+            busy_until = start + busy[i];
+            auto result = acquire(static_cast<int>(i));
+            auto const end = clock::now();
+            if (!result) {
+                std::fprintf(stderr, "acquire failed: %s\n", result.error().message().c_str());
+                std::exit(EXIT_FAILURE);
+            }
+            latencies.push_back(std::chrono::duration<double, std::micro>(end - start).count());
+        }
+        std::sort(latencies.begin(), latencies.end());
+        return latencies;
+    }
+
+    double percentile(std::vector<double> const& sorted, double p) {
+        auto const index = static_cast<std::size_t>(p * (sorted.size() - 1));
+        return sorted[index];
+    }
+
+    void report(char const* name, std::vector<double> const& sorted) {
+        std::printf("%-28s %10.2f %10.2f %10.2f %10.2f\n", name,
+                    percentile(sorted, 0.5), percentile(sorted, 0.99),
+                    percentile(sorted, 0.999), sorted.back());
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    std::size_t const samples = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 5000;
+    double const mean_busy_us = argc > 2 ? std::atof(argv[2]) : 20.0;
+    std::chrono::microseconds const fixed_sleep(argc > 3 ? std::atol(argv[3]) : 100);
+
+    if (samples == 0 or mean_busy_us <= 0) {
+        std::fprintf(stderr, "usage: %s [samples] [mean_busy_us] [fixed_sleep_us]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    // Both strategies see the same sequence of contention intervals.
+    std::mt19937 engine(42);
+    std::exponential_distribution<double> distribution(1.0 / mean_busy_us);
+    std::vector<std::chrono::nanoseconds> busy(samples);
+    for (auto& b : busy)
+        b = std::chrono::nanoseconds(static_cast<long>(distribution(engine) * 1000));
+
+    retry_stats stats;
+    auto const adaptive = retry_on_transient(try_acquire, retry_policy(), &stats);
+
+    std::printf("%zu samples, mean busy %.1fus, fixed sleep %ldus\n",
+                samples, mean_busy_us, static_cast<long>(fixed_sleep.count()));
+    std::printf("%-28s %10s %10s %10s %10s\n", "latency (us)", "p50", "p99", "p999", "max");
+
+    report("retry_on_transient", measure(adaptive, busy));
+    report("fixed sleep", measure([fixed_sleep](int token) { return fixed_sleep_retry(token, fixed_sleep); }, busy));
+
+    std::printf("\nretry_on_transient: %lu calls, %lu retries (%lu spins, %lu yields, %lu sleeps), %lu deadlines exceeded\n",
+                stats.calls.load(), stats.retries.load(), stats.spins.load(),
+                stats.yields.load(), stats.sleeps.load(), stats.deadlines_exceeded.load());
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Compares round trips of error_code_or<long> through the fixed layout
+// wire format against a string based encoding.
+//
+// Usage: wire_format_bench [records]
+//
+// The wire records are encoded directly into a shared file mapping, as
+// a producer would write into a shared memory ring. The benchmark then
+// re-executes itself to decode them in place. A forked child would
+// share the parent's error category addresses; a freshly exec'd
+// process does not, so this shows that the encoding survives the
+// process boundary. The child also checks the raw category and code of
+// every record against the registry identifiers.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <cerrno>
+#include <cstring>
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "../wire_format.hpp"
+
+using namespace acm;
+
+namespace {
+
+    using clock = std::chrono::steady_clock;
+    using element = error_code_or<long>;
+
+    volatile long sink;
+
+    std::vector<element> make_input(std::size_t records) {
+        std::vector<element> input;
+        input.reserve(records);
+        for (std::size_t i = 0; i != records; ++i) {
+            if (i % 8 == 0)
+                input.push_back(element(std::make_error_code(std::errc::resource_unavailable_try_again)));
+            else if (i % 8 == 1)
+                input.push_back(element(std::error_code(EIO, std::system_category())));
+            else
+                input.push_back(element(static_cast<long>(i)));
+        }
+        return input;
+    }
+
+    std::string string_encode(element const& e) {
+        if (e)
+            return "v:" + std::to_string(e.value());
+        return std::string("e:") + e.error().category().name() + ":" + std::to_string(e.error().value());
+    }
+
+    element string_decode(std::string const& s) {
+        if (s[0] == 'v')
+            return std::stol(s.substr(2));
+        auto const colon = s.find(':', 2);
+        std::string const name = s.substr(2, colon - 2);
+        int const code = std::stoi(s.substr(colon + 1));
+        if (name == std::generic_category().name())
+            return std::error_code(code, std::generic_category());
+        return std::error_code(code, std::system_category());
+    }
+
+    long checksum(element const& e) {
+        return e ? e.value() : e.error().value() * 1000 + (&e.error().category() == &std::system_category());
+    }
+
+    double elapsed_ns(clock::time_point start, std::size_t records) {
+        return std::chrono::duration<double, std::nano>(clock::now() - start).count() / records;
+    }
+
+    // The wire image make_input should have produced for record i.
+    bool expected_record(wire_error_code_or<long> const& record, std::size_t i) {
+        if (i % 8 == 0)
+            return record.category == error_category_registry::generic_id and record.code == EAGAIN;
+        if (i % 8 == 1)
+            return record.category == error_category_registry::system_id and record.code == EIO;
+        return record.category == 0 and record.code == 0 and record.value == static_cast<long>(i);
+    }
+
+    // Run in the re-executed process: maps the records the parent
+    // encoded into fd and decodes them against this process's registry.
+    int decode_records(int fd, std::size_t records) {
+        std::size_t const bytes = records * sizeof(wire_error_code_or<long>);
+        void* const region = ::mmap(nullptr, bytes, PROT_READ, MAP_SHARED, fd, 0);
+        if (region == MAP_FAILED)
+            return EXIT_FAILURE;
+        auto const* const ring = static_cast<wire_error_code_or<long> const*>(region);
+
+        long expected = 0;
+        for (auto const& e : make_input(records))
+            expected += checksum(e);
+
+        long sum = 0;
+        element e;
+        for (std::size_t i = 0; i != records; ++i) {
+            if (!expected_record(ring[i], i) or decode(ring[i], e))
+                return EXIT_FAILURE;
+            sum += checksum(e);
+        }
+        ::munmap(region, bytes);
+        return sum == expected ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+
+    // Runs this program again as a fresh process to decode fd.
+    bool decode_in_new_process(char const* self, int fd, std::size_t records) {
+        std::string const fd_arg = std::to_string(fd);
+        std::string const records_arg = std::to_string(records);
+
+        pid_t const child = ::fork();
+        if (child == 0) {
+            ::execlp(self, self, "--decode", fd_arg.c_str(), records_arg.c_str(), static_cast<char*>(nullptr));
+            ::_exit(127);
+        }
+        int status = 0;
+        return child > 0 and ::waitpid(child, &status, 0) == child and
+            WIFEXITED(status) and WEXITSTATUS(status) == EXIT_SUCCESS;
+    }
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    if (argc == 4 and std::strcmp(argv[1], "--decode") == 0)
+        return decode_records(std::atoi(argv[2]), std::strtoul(argv[3], nullptr, 10));
+
+    std::size_t const records = argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 1000000;
+    if (records == 0) {
+        std::fprintf(stderr, "usage: %s [records]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    auto const input = make_input(records);
+    long expected = 0;
+    for (auto const& e : input)
+        expected += checksum(e);
+
+    std::size_t const bytes = records * sizeof(wire_error_code_or<long>);
+    char path[] = "/tmp/wire_format_bench.XXXXXX";
+    int const fd = ::mkstemp(path);
+    if (fd == -1) {
+        std::perror("mkstemp");
+        return EXIT_FAILURE;
+    }
+    ::unlink(path);
+    if (::ftruncate(fd, static_cast<off_t>(bytes)) == -1) {
+        std::perror("ftruncate");
+        return EXIT_FAILURE;
+    }
+    void* const region = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (region == MAP_FAILED) {
+        std::perror("mmap");
+        return EXIT_FAILURE;
+    }
+    auto* const ring = static_cast<wire_error_code_or<long>*>(region);
+
+    auto start = clock::now();
+    for (std::size_t i = 0; i != records; ++i)
+        encode(input[i], ring[i]);
+    double const wire_encode_ns = elapsed_ns(start, records);
+
+    start = clock::now();
+    long wire_sum = 0;
+    element decoded;
+    for (std::size_t i = 0; i != records; ++i) {
+        decode(ring[i], decoded);
+        wire_sum += checksum(decoded);
+    }
+    double const wire_decode_ns = elapsed_ns(start, records);
+
+    std::vector<std::string> strings(records);
+    start = clock::now();
+    for (std::size_t i = 0; i != records; ++i)
+        strings[i] = string_encode(input[i]);
+    double const string_encode_ns = elapsed_ns(start, records);
+
+    start = clock::now();
+    long string_sum = 0;
+    for (std::size_t i = 0; i != records; ++i)
+        string_sum += checksum(string_decode(strings[i]));
+    double const string_decode_ns = elapsed_ns(start, records);
+
+    sink = wire_sum + string_sum;
+    if (wire_sum != expected or string_sum != expected) {
+        std::fprintf(stderr, "round trip mismatch\n");
+        return EXIT_FAILURE;
+    }
+
+    bool const child_ok = decode_in_new_process(argv[0], fd, records);
+    ::munmap(region, bytes);
+    ::close(fd);
+
+    std::printf("%zu records, %zu bytes per wire record\n", records, sizeof(wire_error_code_or<long>));
+    std::printf("%-10s %14s %14s\n", "ns/record", "encode", "decode");
+    std::printf("%-10s %14.2f %14.2f\n", "wire", wire_encode_ns, wire_decode_ns);
+    std::printf("%-10s %14.2f %14.2f\n", "string", string_encode_ns, string_decode_ns);
+    std::printf("cross process decode: %s\n", child_ok ? "ok" : "FAILED");
+
+    return child_ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
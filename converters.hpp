@@ -15,10 +15,17 @@
 #ifndef included_3052c160_4439_448e_8678_dfdc0172440e
 #define included_3052c160_4439_448e_8678_dfdc0172440e
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <functional>
+#include <initializer_list>
 #include <system_error>
+#include <thread>
+#include <vector>
 
 #include "error_or.hpp"
+#include "detail/cpu_relax.hpp"
 
 namespace acm {
 
@@ -64,6 +71,119 @@ namespace acm {
         };
     }
 
+    // Controls how retry_on_transient waits between attempts. The first
+    // spin_retries retries busy wait with an exponentially growing
+    // number of pause instructions, the next yield_retries retries yield
+    // the processor, and any further retries sleep for an exponentially
+    // growing interval capped at max_sleep. No retry is started once
+    // deadline has elapsed since the first attempt; the last error is
+    // returned instead.
+    struct retry_policy {
+        std::vector<std::error_condition> retry_on = {
+            std::errc::resource_unavailable_try_again,
+            std::errc::operation_would_block,
+            std::errc::interrupted,
+        };
+        unsigned spin_retries = 16;
+        unsigned yield_retries = 8;
+        std::chrono::microseconds initial_sleep = std::chrono::microseconds(10);
+        std::chrono::microseconds max_sleep = std::chrono::microseconds(1000);
+        std::chrono::microseconds deadline = std::chrono::microseconds(100000);
+
+        retry_policy() = default;
+
+        inline retry_policy(std::initializer_list<std::error_condition> conditions)
+            : retry_on(conditions) {}
+
+        inline bool should_retry(std::error_code const& error) const {
+            return std::find(retry_on.begin(), retry_on.end(), error) != retry_on.end();
+        }
+    };
+
+    // Counters updated by retry_on_transient. They may be shared by
+    // many concurrent callers, so each is atomic.
+    struct retry_stats {
+        std::atomic<unsigned long> calls{0};
+        std::atomic<unsigned long> retries{0};
+        std::atomic<unsigned long> spins{0};
+        std::atomic<unsigned long> yields{0};
+        std::atomic<unsigned long> sleeps{0};
+        std::atomic<unsigned long> deadlines_exceeded{0};
+    };
+
+    namespace detail {
+
+        template<typename T, typename F>
+        error_code_or<T> retry_call(F const& attempt, retry_policy const& policy, retry_stats* stats) {
+            using clock = std::chrono::steady_clock;
+
+            if (stats)
+                stats->calls.fetch_add(1, std::memory_order_relaxed);
+
+            // The deadline runs from the first attempt, so a slow first
+            // call counts against it.
+            auto const give_up_at = clock::now() + policy.deadline;
+
+            error_code_or<T> result = attempt();
+            if (result or !policy.should_retry(result.error()))
+                return result;
+
+            auto sleep = policy.initial_sleep;
+
+            for (unsigned retry = 0; ; ++retry) {
+                if (clock::now() >= give_up_at) {
+                    if (stats)
+                        stats->deadlines_exceeded.fetch_add(1, std::memory_order_relaxed);
+                    return result;
+                }
+
+                if (retry < policy.spin_retries) {
+                    for (unsigned i = 0, n = 1u << std::min(retry, 6u); i != n; ++i)
+                        cpu_relax();
+                    if (stats)
+                        stats->spins.fetch_add(1, std::memory_order_relaxed);
+                } else if (retry < policy.spin_retries + policy.yield_retries) {
+                    std::this_thread::yield();
+                    if (stats)
+                        stats->yields.fetch_add(1, std::memory_order_relaxed);
+                } else {
+                    auto const remaining = give_up_at - clock::now();
+                    if (remaining < sleep)
+                        std::this_thread::sleep_for(remaining);
+                    else
+                        std::this_thread::sleep_for(sleep);
+                    sleep = std::min(sleep * 2, policy.max_sleep);
+                    if (stats)
+                        stats->sleeps.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                if (stats)
+                    stats->retries.fetch_add(1, std::memory_order_relaxed);
+
+                result = attempt();
+                if (result or !policy.should_retry(result.error()))
+                    return result;
+            }
+        }
+
+    } // namespace detail
+
+    template<typename T, typename ...Args>
+    auto retry_on_transient(error_code_or<T>(returns_error_code_or)(Args...), retry_policy policy = retry_policy(), retry_stats* stats = nullptr) -> std::function<error_code_or<T>(Args...)> {
+        return [returns_error_code_or, policy, stats](Args&&... args) -> error_code_or<T> {
+            // Arguments are passed as lvalues so that each attempt sees them intact.
+            return detail::retry_call<T>([&]() { return returns_error_code_or(args...); }, policy, stats);
+        };
+    }
+
+    template<typename T, typename ...Args>
+    auto retry_on_transient(std::function<error_code_or<T>(Args...)> returns_error_code_or, retry_policy policy = retry_policy(), retry_stats* stats = nullptr) -> std::function<error_code_or<T>(Args...)> {
+        return [returns_error_code_or, policy, stats](Args&&... args) -> error_code_or<T> {
+            // Arguments are passed as lvalues so that each attempt sees them intact.
+            return detail::retry_call<T>([&]() { return returns_error_code_or(args...); }, policy, stats);
+        };
+    }
+
 } // namespace acm
 
 #endif // included_3052c160_4439_448e_8678_dfdc0172440e
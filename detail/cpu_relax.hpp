@@ -0,0 +1,39 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_43978976_a87a_4321_95f2_3f567e0a8f67
+#define included_43978976_a87a_4321_95f2_3f567e0a8f67
+
+namespace acm {
+namespace detail  {
+
+    // Hints to the processor that we are in a spin wait loop. On x86
+    // this is PAUSE, which avoids the memory order mis-speculation
+    // penalty on loop exit and yields pipeline resources to a sibling
+    // hyperthread. On ARM it is YIELD. Elsewhere it is only a compiler
+    // barrier.
+    inline void cpu_relax() noexcept {
+#if defined(__i386__) || defined(__x86_64__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#else
+        asm volatile("" ::: "memory");
+#endif
+    }
+
+} // namespace detail
+} // namespace acm
+
+#endif // included_43978976_a87a_4321_95f2_3f567e0a8f67
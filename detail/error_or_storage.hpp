@@ -0,0 +1,187 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_dad151b2_e8fb_4cf9_aff6_8ee8d4cf2206
+#define included_dad151b2_e8fb_4cf9_aff6_8ee8d4cf2206
+
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Member functions that mutate, or that need more than a single return
+// statement, can only be constexpr under the C++14 rules.
+#if defined(__cpp_constexpr) && __cpp_constexpr >= 201304
+#define ACM_RELAXED_CONSTEXPR constexpr
+#else
+#define ACM_RELAXED_CONSTEXPR
+#endif
+
+namespace acm {
+namespace detail  {
+
+    struct error_or_default_tag {};
+    struct error_or_value_tag {};
+    struct error_or_error_tag {};
+    struct error_or_active_member_tag {};
+
+    // The storage for error_or. When both E and T are trivially
+    // destructible the storage is too, which is what allows error_or to
+    // be a literal type. Members are initialized through the value and
+    // error tagged constructors in constant expressions.
+    //
+    // The active member tagged constructor builds whichever of value or
+    // error ok selects, with placement new, for copying and converting
+    // at runtime. Should that throw, the storage was never constructed,
+    // so its destructor does not run over the unconstructed member.
+    //
+    // The default tagged constructor default-initializes the value, so
+    // that a trivial value, such as a large buffer, is not zero filled.
+    // That cannot happen in a constant expression.
+    template<typename E, typename T,
+             bool = std::is_trivially_destructible<E>::value and std::is_trivially_destructible<T>::value>
+    struct error_or_storage {
+
+        template<typename... Args>
+        inline constexpr error_or_storage(error_or_value_tag tag, Args&&... args)
+            : val_(tag, static_cast<Args&&>(args)...), ok_(true) {}
+
+        template<typename... Args>
+        inline constexpr error_or_storage(error_or_error_tag tag, Args&&... args)
+            : val_(tag, static_cast<Args&&>(args)...), ok_(false) {}
+
+        inline explicit error_or_storage(error_or_default_tag) {
+            new(&val_.value) T;
+        }
+
+        template<typename V, typename R>
+        inline error_or_storage(error_or_active_member_tag, bool ok, V&& value, R&& error) {
+            if (ok)
+                new(&val_.value) T(static_cast<V&&>(value));
+            else
+                new(&val_.error) E(static_cast<R&&>(error));
+            ok_ = ok;
+        }
+
+        inline ~error_or_storage() noexcept(std::is_nothrow_destructible<E>::value and
+                                            std::is_nothrow_destructible<T>::value) {
+            if (ok_)
+                val_.value.~T();
+            else
+                val_.error.~E();
+        }
+
+        union val {
+            // The lifecycle of members is handled by the enclosing class.
+            inline val() noexcept {}
+
+            template<typename... Args>
+            inline constexpr val(error_or_value_tag, Args&&... args)
+                : value(static_cast<Args&&>(args)...) {}
+
+            template<typename... Args>
+            inline constexpr val(error_or_error_tag, Args&&... args)
+                : error(static_cast<Args&&>(args)...) {}
+
+            inline ~val() noexcept {}
+
+            T value;
+            E error;
+        } val_;
+
+        bool ok_ = true;
+    };
+
+    template<typename E, typename T>
+    struct error_or_storage<E, T, true> {
+
+        template<typename... Args>
+        inline constexpr error_or_storage(error_or_value_tag tag, Args&&... args)
+            : val_(tag, static_cast<Args&&>(args)...), ok_(true) {}
+
+        template<typename... Args>
+        inline constexpr error_or_storage(error_or_error_tag tag, Args&&... args)
+            : val_(tag, static_cast<Args&&>(args)...), ok_(false) {}
+
+        inline explicit error_or_storage(error_or_default_tag) {
+            new(&val_.value) T;
+        }
+
+        template<typename V, typename R>
+        inline error_or_storage(error_or_active_member_tag, bool ok, V&& value, R&& error) {
+            if (ok)
+                new(&val_.value) T(static_cast<V&&>(value));
+            else
+                new(&val_.error) E(static_cast<R&&>(error));
+            ok_ = ok;
+        }
+
+        union val {
+            inline val() noexcept {}
+
+            template<typename... Args>
+            inline constexpr val(error_or_value_tag, Args&&... args)
+                : value(static_cast<Args&&>(args)...) {}
+
+            template<typename... Args>
+            inline constexpr val(error_or_error_tag, Args&&... args)
+                : error(static_cast<Args&&>(args)...) {}
+
+            T value;
+            E error;
+        } val_;
+
+        bool ok_ = true;
+    };
+
+    // Adds copy and move construction to error_or_storage. When E and T
+    // are trivially copyable the implicit, constexpr, member-wise copy
+    // of the storage is correct; otherwise the active member is copied
+    // or moved through the active member constructor.
+    template<typename E, typename T,
+             bool = std::is_trivially_copyable<E>::value and std::is_trivially_copyable<T>::value and
+                    std::is_trivially_destructible<E>::value and std::is_trivially_destructible<T>::value>
+    struct error_or_copy_base : error_or_storage<E, T> {
+
+        using error_or_storage<E, T>::error_or_storage;
+
+        inline error_or_copy_base(error_or_copy_base const& other) noexcept(std::is_nothrow_copy_constructible<E>::value and
+                                                                            std::is_nothrow_copy_constructible<T>::value)
+            : error_or_storage<E, T>(error_or_active_member_tag(), other.ok_, other.val_.value, other.val_.error) {}
+
+        inline error_or_copy_base(error_or_copy_base&& other) noexcept((std::is_nothrow_move_constructible<E>::value or
+                                                                        std::is_nothrow_copy_constructible<E>::value) and
+                                                                       (std::is_nothrow_move_constructible<T>::value or
+                                                                        std::is_nothrow_copy_constructible<T>::value))
+            : error_or_storage<E, T>(error_or_active_member_tag(), other.ok_,
+                                     std::move_if_noexcept(other.val_.value),
+                                     std::move_if_noexcept(other.val_.error)) {}
+
+        error_or_copy_base& operator=(error_or_copy_base const&) = delete;
+    };
+
+    template<typename E, typename T>
+    struct error_or_copy_base<E, T, true> : error_or_storage<E, T> {
+
+        using error_or_storage<E, T>::error_or_storage;
+
+        error_or_copy_base(error_or_copy_base const&) = default;
+        error_or_copy_base(error_or_copy_base&&) = default;
+
+        error_or_copy_base& operator=(error_or_copy_base const&) = delete;
+    };
+
+} // namespace detail
+} // namespace acm
+
+#endif // included_dad151b2_e8fb_4cf9_aff6_8ee8d4cf2206
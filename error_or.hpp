@@ -21,18 +21,24 @@
 #include <system_error>
 #include <type_traits>
 
+#include "detail/error_or_storage.hpp"
 #include "detail/is_nothrow_swappable.hpp"
 
 namespace acm {
 
     template<typename E, typename T>
-    class error_or final {
+    class error_or final : private detail::error_or_copy_base<E, T> {
 
     public:
         using error_type = E;
         using value_type = T;
 
     private:
+        using base_type = detail::error_or_copy_base<E, T>;
+
+        template<typename E2, typename T2>
+        friend class error_or;
+
         static bool constexpr is_nothrow_swappable =
             detail::is_nothrow_swappable<error_type>::value and
             detail::is_nothrow_swappable<value_type>::value and
@@ -42,66 +48,40 @@ namespace acm {
             std::is_nothrow_destructible<value_type>::value;
 
     public:
-        inline error_or() noexcept(std::is_nothrow_default_constructible<value_type>::value) {
-            new(&val_.value) value_type;
-        }
+        // Default-initializes the value, so this is the one constructor
+        // that is not usable in constant expressions.
+        inline error_or() noexcept(std::is_nothrow_default_constructible<value_type>::value)
+            : base_type(detail::error_or_default_tag()) {}
 
-        inline error_or(error_type error) noexcept(std::is_nothrow_move_constructible<error_type>::value)
-            : ok_(false) {
-            assert(error);
-            new(&val_.error) error_type(std::move(error));
-        }
+        inline constexpr error_or(error_type error) noexcept(std::is_nothrow_move_constructible<error_type>::value)
+            : base_type(detail::error_or_error_tag(), checked_error(error)) {}
 
-        inline error_or(value_type value) noexcept(std::is_nothrow_move_constructible<value_type>::value) {
-            new(&val_.value) value_type(std::move(value));
-        }
+        inline constexpr error_or(value_type value) noexcept(std::is_nothrow_move_constructible<value_type>::value)
+            : base_type(detail::error_or_value_tag(), static_cast<value_type&&>(value)) {}
 
         template<typename U = value_type>
-        inline error_or(std::initializer_list<typename U::value_type> values) noexcept(std::is_nothrow_constructible<U, std::initializer_list<typename U::value_type>>::value) {
-            new(&val_.value) value_type(values);
-        }
-
-        inline error_or(error_or const& other) noexcept(std::is_nothrow_copy_constructible<error_type>::value and
-                                                        std::is_nothrow_copy_constructible<value_type>::value) {
-            if (other.ok_)
-                new(&val_.value) value_type(other.val_.value);
-            else
-                new(&val_.error) error_type(other.val_.error);
-            ok_ = other.ok_;
-        }
+        inline error_or(std::initializer_list<typename U::value_type> values) noexcept(std::is_nothrow_constructible<U, std::initializer_list<typename U::value_type>>::value)
+            : base_type(detail::error_or_value_tag(), values) {}
 
-        inline error_or(error_or&& other) noexcept((std::is_nothrow_move_constructible<error_type>::value or
-                                                    std::is_nothrow_copy_constructible<error_type>::value) and
-                                                   (std::is_nothrow_move_constructible<value_type>::value or
-                                                    std::is_nothrow_copy_constructible<value_type>::value)) {
-            if (other.ok_)
-                new(&val_.value) value_type(std::move_if_noexcept(other.val_.value));
-            else
-                new(&val_.error) error_type(std::move_if_noexcept(other.val_.error));
-            ok_ = other.ok_;
-        }
+        // Copy and move construction are provided by the base, and are
+        // trivial, and so usable in constant expressions, when E and T
+        // are trivially copyable.
+        error_or(error_or const&) = default;
+        error_or(error_or&&) = default;
 
         template<typename U>
         inline error_or(error_or<error_type, U> const& other) noexcept(std::is_nothrow_copy_constructible<error_type>::value and
-                                                                       std::is_nothrow_copy_constructible<value_type>::value) {
-            if (other.ok_)
-                new(&val_.value) value_type(other.val_.value);
-            else
-                new(&val_.error) error_type(other.val_.error);
-            ok_ = other.ok_;
-        }
+                                                                       std::is_nothrow_copy_constructible<value_type>::value)
+            : base_type(detail::error_or_active_member_tag(), other.ok_, other.val_.value, other.val_.error) {}
 
         template<typename U>
         inline error_or(error_or<error_type, U>&& other) noexcept((std::is_nothrow_move_constructible<error_type>::value or
                                                                    std::is_nothrow_copy_constructible<error_type>::value) and
                                                                   (std::is_nothrow_constructible<value_type, typename std::add_rvalue_reference<U>::type>::value or
-                                                                   std::is_nothrow_constructible<value_type, typename std::add_lvalue_reference<U>::type>::value)) {
-            if (other.ok_)
-                new(&val_.value) value_type(move_if_noexcept_from(other.val_.value));
-            else
-                new(&val_.error) error_type(std::move_if_noexcept(other.val_.error));
-            ok_ = other.ok_;
-        }
+                                                                   std::is_nothrow_constructible<value_type, typename std::add_lvalue_reference<U>::type>::value))
+            : base_type(detail::error_or_active_member_tag(), other.ok_,
+                        move_if_noexcept_from(other.val_.value),
+                        std::move_if_noexcept(other.val_.error)) {}
 
         void swap(error_or& other) noexcept(is_nothrow_swappable) {
             other.sfinae_swap(*this);
@@ -132,85 +112,73 @@ namespace acm {
             return *this;
         }
 
-        inline ~error_or() noexcept(std::is_nothrow_destructible<error_type>::value and
-                                    std::is_nothrow_destructible<value_type>::value) {
-            if (ok_)
-                val_.value.~value_type();
-            else
-                val_.error.~error_type();
+        inline constexpr bool ok() const noexcept {
+            return this->ok_;
         }
 
-        inline bool ok() const noexcept {
-            return ok_;
+        inline constexpr explicit operator bool() const noexcept {
+            return this->ok_;
         }
 
-        inline explicit operator bool() const noexcept {
-            return ok_;
+        inline constexpr error_type const& error() const noexcept {
+            return assert(!this->ok_), this->val_.error;
         }
 
-        inline error_type const& error() const noexcept {
-            assert(!ok_);
-            return val_.error;
+        inline ACM_RELAXED_CONSTEXPR value_type& value() noexcept {
+            return assert(this->ok_), this->val_.value;
         }
 
-        inline value_type& value() noexcept {
-            assert(ok_);
-            return val_.value;
+        inline constexpr value_type const& value() const noexcept {
+            return assert(this->ok_), this->val_.value;
         }
 
-        inline value_type const& value() const noexcept {
-            assert(ok_);
-            return val_.value;
+        inline ACM_RELAXED_CONSTEXPR error_type&& release_error() noexcept {
+            return assert(!this->ok_), static_cast<error_type&&>(this->val_.error);
         }
 
-        inline error_type&& release_error() noexcept {
-            assert(!ok_);
-            return std::move(val_.error);
-        }
-
-        inline value_type&& release_value() noexcept {
-            assert(ok_);
-            return std::move(val_.value);
+        inline ACM_RELAXED_CONSTEXPR value_type&& release_value() noexcept {
+            return assert(this->ok_), static_cast<value_type&&>(this->val_.value);
         }
 
     private:
-        union val {
-            // The lifecycle of members is handled by the enclosing class.
-            inline val() noexcept {}
-            inline ~val() noexcept {}
-            value_type value;
-            error_type error;
-        } val_;
-
-        bool ok_ = true;
+        // Asserts on the way through that an error really is an error,
+        // in a form that C++11 accepts in a constexpr constructor.
+        static inline constexpr error_type&& checked_error(error_type& error) noexcept {
+            return assert(error), static_cast<error_type&&>(error);
+        }
 
         template<typename U = value_type>
         typename std::enable_if<error_or<error_type, U>::is_nothrow_swappable>::type sfinae_swap(error_or& other) noexcept {
             using std::swap;
 
-            if (ok_ == other.ok_) {
-                if (ok_)
-                    swap(val_.value, other.val_.value);
+            if (this->ok_ == other.ok_) {
+                if (this->ok_)
+                    swap(this->val_.value, other.val_.value);
                 else
-                    swap(val_.error, other.val_.error);
+                    swap(this->val_.error, other.val_.error);
             } else {
-                if (ok_) {
-                    new(&val_.error) error_type(std::move(other.val_.error));
-                    new(&other.val_.value) value_type(std::move(val_.value));
-                    val_.value.~value_type();
+                // The value and error share storage, so the outgoing
+                // member must be moved aside before the incoming one
+                // can be constructed in its place.
+                if (this->ok_) {
+                    value_type moved(std::move(this->val_.value));
+                    this->val_.value.~value_type();
+                    new(&this->val_.error) error_type(std::move(other.val_.error));
                     other.val_.error.~error_type();
+                    new(&other.val_.value) value_type(std::move(moved));
                 } else {
-                    new(&other.val_.error) error_type(std::move(val_.error));
-                    new(&val_.value) value_type(std::move(other.val_.value));
+                    value_type moved(std::move(other.val_.value));
                     other.val_.value.~value_type();
-                    val_.error.~error_type();
+                    new(&other.val_.error) error_type(std::move(this->val_.error));
+                    this->val_.error.~error_type();
+                    new(&this->val_.value) value_type(std::move(moved));
                 }
-                swap(ok_, other.ok_);
+                swap(this->ok_, other.ok_);
             }
         }
 
         template<typename U>
-        typename std::conditional
+        static typename std::conditional
         <
             !std::is_nothrow_constructible<value_type, typename std::add_rvalue_reference<U>::type>::value and std::is_constructible<U, typename std::add_lvalue_reference<U>::type>::value,
             U const&,
@@ -223,21 +191,15 @@ namespace acm {
     };
 
     template<typename E1, typename T1, typename E2, typename T2>
-    bool operator==(error_or<E1, T1> const& lhs, error_or<E2, T2> const& rhs) noexcept(noexcept(lhs.value() == rhs.value()) and
-                                                                                       noexcept(lhs.error() == rhs.error())) {
-        if (lhs.ok() == rhs.ok()) {
-            if (lhs.ok()) {
-                return lhs.value() == rhs.value();
-            } else {
-                return lhs.error() == rhs.error();
-            }
-        }
-        return false;
+    constexpr bool operator==(error_or<E1, T1> const& lhs, error_or<E2, T2> const& rhs) noexcept(noexcept(lhs.value() == rhs.value()) and
+                                                                                                 noexcept(lhs.error() == rhs.error())) {
+        return lhs.ok() != rhs.ok() ? false :
+            lhs.ok() ? lhs.value() == rhs.value() : lhs.error() == rhs.error();
     }
 
     template<typename E1, typename T1, typename E2, typename T2>
-    bool operator!=(error_or<E1, T1> const& lhs, error_or<E2, T2> const& rhs) noexcept(noexcept(lhs == rhs)) {
-        return not lhs == rhs;
+    constexpr bool operator!=(error_or<E1, T1> const& lhs, error_or<E2, T2> const& rhs) noexcept(noexcept(lhs == rhs)) {
+        return !(lhs == rhs);
     }
 
     template<typename T>
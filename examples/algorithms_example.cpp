@@ -0,0 +1,135 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks which elements the range algorithms return, and in what order.
+// Values are long enough to live on the heap, so build with
+// -fsanitize=address to catch a value used after it was moved out; the
+// checks themselves report by exit status.
+
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "../algorithms.hpp"
+
+using namespace acm;
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, char const* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    using result = error_code_or<std::string>;
+
+    std::string long_value(char c) {
+        return std::string(64, c);
+    }
+
+    std::error_code error(std::errc e) {
+        return std::make_error_code(e);
+    }
+
+    // a, io_error, b, invalid_argument, c
+    std::vector<result> mixed() {
+        std::vector<result> results;
+        results.emplace_back(long_value('a'));
+        results.emplace_back(error(std::errc::io_error));
+        results.emplace_back(long_value('b'));
+        results.emplace_back(error(std::errc::invalid_argument));
+        results.emplace_back(long_value('c'));
+        return results;
+    }
+
+    void collect_values() {
+        std::vector<result> results;
+        results.emplace_back(long_value('a'));
+        results.emplace_back(long_value('b'));
+        results.emplace_back(long_value('c'));
+
+        auto const collected = collect(results.begin(), results.end());
+        check(collected.ok(), "collect succeeds when every element holds a value");
+        check(collected.ok() and
+              collected.value() == std::vector<std::string>{long_value('a'), long_value('b'), long_value('c')},
+              "collect keeps the values in order");
+
+        std::vector<result> empty;
+        auto const nothing = collect(empty.begin(), empty.end());
+        check(nothing.ok() and nothing.value().empty(), "collect of an empty range is an empty vector");
+    }
+
+    void collect_first_error() {
+        auto results = mixed();
+        auto const collected = collect(results.begin(), results.end());
+        check(!collected.ok() and collected.error() == std::errc::io_error, "collect returns the first error");
+    }
+
+    void partition_keeps_order() {
+        auto results = mixed();
+        auto const parts = partition_results(results.begin(), results.end());
+        check(parts.first == std::vector<std::string>{long_value('a'), long_value('b'), long_value('c')},
+              "partition_results keeps the values in order");
+        check(parts.second.size() == 2 and
+              parts.second[0] == std::errc::io_error and parts.second[1] == std::errc::invalid_argument,
+              "partition_results keeps the errors in order");
+
+        std::vector<result> empty;
+        auto const none = partition_results(empty.begin(), empty.end());
+        check(none.first.empty() and none.second.empty(), "partition_results of an empty range is empty");
+    }
+
+    void partition_in_place() {
+        auto results = mixed();
+        auto const errors = partition_results_in_place(results.begin(), results.end());
+        check(errors == results.begin() + 3, "the returned iterator is at the first error");
+        check(results[0].ok() and results[0].value() == long_value('a') and
+              results[1].ok() and results[1].value() == long_value('b') and
+              results[2].ok() and results[2].value() == long_value('c'),
+              "partition_results_in_place keeps the values in order");
+        check(first_error(results.begin(), results.end()) == errors and
+              !results[3].ok() and !results[4].ok(),
+              "every element from the returned iterator holds an error");
+
+        std::vector<result> values;
+        values.emplace_back(long_value('a'));
+        check(partition_results_in_place(values.begin(), values.end()) == values.end(),
+              "with no errors the returned iterator is the end");
+
+        std::vector<result> empty;
+        check(partition_results_in_place(empty.begin(), empty.end()) == empty.end(),
+              "an empty range is already partitioned");
+    }
+
+} // namespace
+
+int main() {
+
+    collect_values();
+    collect_first_error();
+    partition_keeps_order();
+    partition_in_place();
+
+    if (failures) {
+        std::printf("%d algorithm checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All algorithm checks passed\n");
+    return EXIT_SUCCESS;
+}
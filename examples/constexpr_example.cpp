@@ -0,0 +1,134 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Parses and validates a static table at compile time with error_or,
+// then runs the same parser over the same table at runtime to show the
+// two paths agree and what the runtime validation costs. Requires C++14.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+
+#include "../algorithms.hpp"
+#include "../error_or.hpp"
+
+#if !defined(__cpp_constexpr) || __cpp_constexpr < 201304
+#error "constexpr_example requires C++14 constexpr"
+#endif
+
+using namespace acm;
+
+namespace {
+
+    struct parse_error {
+        enum code_type : int { none, empty, not_a_number, out_of_range };
+        code_type code;
+
+        constexpr explicit operator bool() const noexcept {
+            return code != none;
+        }
+
+        friend constexpr bool operator==(parse_error lhs, parse_error rhs) noexcept {
+            return lhs.code == rhs.code;
+        }
+    };
+
+    template<typename T>
+    using parse_result = error_or<parse_error, T>;
+
+    constexpr parse_result<unsigned> parse_port(char const* text) {
+        if (*text == '\0')
+            return parse_error{parse_error::empty};
+        unsigned long port = 0;
+        for (; *text != '\0'; ++text) {
+            if (*text < '0' or *text > '9')
+                return parse_error{parse_error::not_a_number};
+            port = port * 10 + static_cast<unsigned long>(*text - '0');
+            if (port > 65535)
+                return parse_error{parse_error::out_of_range};
+        }
+        return static_cast<unsigned>(port);
+    }
+
+    // Construction, observers and comparison.
+    static_assert(parse_port("8080").ok(), "8080 should parse");
+    static_assert(parse_port("8080").value() == 8080, "8080 should parse to 8080");
+    static_assert(!parse_port(""), "empty should not parse");
+    static_assert(parse_port("").error() == parse_error{parse_error::empty}, "empty should be empty");
+    static_assert(parse_port("80x").error() == parse_error{parse_error::not_a_number}, "80x is not a number");
+    static_assert(parse_port("65536").error() == parse_error{parse_error::out_of_range}, "65536 is out of range");
+    static_assert(parse_port("443") == parse_result<unsigned>(443u), "443 should equal 443");
+    static_assert(parse_port("443") != parse_port("444"), "443 should not equal 444");
+    static_assert(parse_port("443") != parse_port("x"), "a value should not equal an error");
+
+    // Copying, and releasing from a mutable error_or.
+    constexpr unsigned release_port(char const* text) {
+        auto result = parse_port(text);
+        auto copy = result;
+        return copy ? copy.release_value() : 0;
+    }
+    static_assert(release_port("22") == 22, "22 should release 22");
+    static_assert(release_port("-") == 0, "- should release nothing");
+
+    // A static table, validated as a whole.
+    constexpr char const* port_text[] = { "22", "80", "443", "8080", "27017" };
+
+    constexpr parse_result<unsigned> ports[] = {
+        parse_port(port_text[0]), parse_port(port_text[1]), parse_port(port_text[2]),
+        parse_port(port_text[3]), parse_port(port_text[4]),
+    };
+    static_assert(first_error(std::begin(ports), std::end(ports)) == std::end(ports), "every port should parse");
+    static_assert(ports[4].value() == 27017, "the last port should be 27017");
+
+    constexpr parse_result<unsigned> bad_ports[] = {
+        parse_port("22"), parse_port("http"), parse_port("99999"),
+    };
+    static_assert(first_error(std::begin(bad_ports), std::end(bad_ports)) == std::begin(bad_ports) + 1,
+                  "the second port should be the first error");
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+
+    long const rounds = argc > 1 ? std::atol(argv[1]) : 1000000;
+
+    // Launder the table so that the runtime path really runs.
+    char const* const* volatile table = port_text;
+    std::size_t const size = std::end(port_text) - std::begin(port_text);
+
+    for (std::size_t i = 0; i != size; ++i) {
+        auto const runtime = parse_port(table[i]);
+        if (runtime != ports[i]) {
+            std::printf("Runtime and compile time parses of %s disagree\n", port_text[i]);
+            return EXIT_FAILURE;
+        }
+    }
+    std::printf("Runtime and compile time parses of %zu ports agree\n", size);
+
+    auto const start = std::chrono::steady_clock::now();
+    unsigned long checksum = 0;
+    for (long round = 0; round != rounds; ++round) {
+        for (std::size_t i = 0; i != size; ++i) {
+            auto const runtime = parse_port(table[i]);
+            checksum += runtime ? runtime.value() : 0;
+        }
+    }
+    auto const elapsed = std::chrono::steady_clock::now() - start;
+
+    std::printf("Runtime validation of the table costs %.1fns (checksum %lu); the compile time table costs nothing\n",
+                std::chrono::duration<double, std::nano>(elapsed).count() / rounds, checksum);
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,141 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Exercises the member lifecycle of error_or where the value and error
+// share storage. Build with -fsanitize=address to catch misuse of that
+// storage; the checks themselves report by exit status.
+
+#include <cstdio>
+#include <cstdlib>
+#include <stdexcept>
+#include <string>
+
+#include "../error_or.hpp"
+
+using namespace acm;
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, char const* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    // A value long enough to live on the heap, so that any use of the
+    // moved-from or overwritten storage is visible to the sanitizers.
+    std::string const long_value(64, 'v');
+
+    void swap_mixed_states() {
+        error_code_or<std::string> value(long_value);
+        error_code_or<std::string> error(std::make_error_code(std::errc::io_error));
+
+        swap(value, error);
+        check(!value and value.error() == std::errc::io_error, "swap moves the error into the former value");
+        check(error and error.value() == long_value, "swap moves the value into the former error");
+
+        swap(value, error);
+        check(value and value.value() == long_value, "swapping back restores the value");
+        check(!error and error.error() == std::errc::io_error, "swapping back restores the error");
+    }
+
+    void assign_across_states() {
+        error_code_or<std::string> result(std::make_error_code(std::errc::io_error));
+        result = long_value;
+        check(result and result.value() == long_value, "assigning a value over an error");
+
+        result = std::make_error_code(std::errc::invalid_argument);
+        check(!result and result.error() == std::errc::invalid_argument, "assigning an error over a value");
+    }
+
+    // Source for the converting constructors.
+    struct Convertible {
+        int n;
+    };
+
+    // Counts live instances, and throws from copy construction once
+    // armed. It has no move constructor, so moves copy too.
+    struct Throwy {
+        static int live;
+        static bool armed;
+
+        Throwy() { ++live; }
+        Throwy(Convertible) { ++live; }
+        Throwy(Throwy const&) {
+            if (armed)
+                throw std::runtime_error("copy");
+            ++live;
+        }
+        ~Throwy() { --live; }
+    };
+
+    int Throwy::live = 0;
+    bool Throwy::armed = false;
+
+    // A value whose copy throws must leave the source intact and the
+    // destination unconstructed, with no destructor run on it.
+    void throwing_copy() {
+        {
+            error_code_or<Throwy> source{Throwy()};
+            check(Throwy::live == 1, "one live value before copying");
+
+            Throwy::armed = true;
+            bool threw = false;
+            try {
+                error_code_or<Throwy> copy(source);
+            } catch (std::runtime_error const&) {
+                threw = true;
+            }
+            check(threw, "copying a throwing value throws");
+            check(Throwy::live == 1, "a throwing copy destroys nothing");
+
+            threw = false;
+            try {
+                error_code_or<Throwy> moved(std::move(source));
+            } catch (std::runtime_error const&) {
+                threw = true;
+            }
+            check(threw, "moving a throwing value throws");
+            check(Throwy::live == 1, "a throwing move destroys nothing");
+            check(source.ok(), "the source keeps its value");
+            Throwy::armed = false;
+        }
+        check(Throwy::live == 0, "the source value is destroyed with the source");
+
+        {
+            error_code_or<Convertible> source(Convertible{1});
+            error_code_or<Throwy> converted(source);
+            check(converted.ok() and Throwy::live == 1, "converting constructs one value");
+        }
+        check(Throwy::live == 0, "the converted value is destroyed");
+    }
+
+} // namespace
+
+int main() {
+
+    swap_mixed_states();
+    assign_across_states();
+    throwing_copy();
+
+    if (failures) {
+        std::printf("%d lifecycle checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All lifecycle checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,160 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks where result_future continuations run, how abandoned promises
+// are reported, and what when_all delivers. Build with -pthread, and
+// with -fsanitize=thread to check the handoffs between threads; the
+// checks themselves report by exit status.
+
+#include <cstdio>
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+#include "../result_future.hpp"
+
+using namespace acm;
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, char const* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    bool is_broken_promise(error_code_or<int> const& result) {
+        return !result and result.error() == std::future_errc::broken_promise;
+    }
+
+    void then_when_ready() {
+        error_code_promise<int> promise;
+        auto future = promise.get_future();
+        promise.set_value(1);
+
+        std::thread::id ran_on;
+        auto next = future.then([&ran_on](error_code_or<int> result) {
+            ran_on = std::this_thread::get_id();
+            return error_code_or<int>(result.value() + 1);
+        });
+        check(!future.valid(), "then leaves the source future invalid");
+        check(next.ready(), "then on a ready future runs before returning");
+        check(ran_on == std::this_thread::get_id(), "then on a ready future runs on the calling thread");
+        check(next.get().value() == 2, "then delivers what the continuation returns");
+    }
+
+    void then_when_pending() {
+        error_code_promise<int> promise;
+        std::thread::id ran_on;
+        auto next = promise.get_future().then([&ran_on](error_code_or<int> result) {
+            ran_on = std::this_thread::get_id();
+            return result;
+        });
+        check(!next.ready(), "then on a pending future does not run the continuation");
+
+        std::thread::id set_on;
+        std::thread setter([&promise, &set_on]() {
+            set_on = std::this_thread::get_id();
+            promise.set_value(3);
+        });
+        auto const result = next.get();
+        setter.join();
+
+        check(result and result.value() == 3, "then delivers the value once it is set");
+        check(ran_on == set_on, "then on a pending future runs on the thread that sets the result");
+    }
+
+    void dropped_promise() {
+        error_code_future<int> future;
+        {
+            error_code_promise<int> promise;
+            future = promise.get_future();
+        }
+        check(future.ready(), "dropping a promise completes its future");
+        check(is_broken_promise(future.get()), "a dropped promise delivers broken_promise");
+
+        bool saw_broken = false;
+        error_code_future<int> next;
+        {
+            error_code_promise<int> promise;
+            next = promise.get_future().then([&saw_broken](error_code_or<int> result) {
+                saw_broken = is_broken_promise(result);
+                return result;
+            });
+        }
+        check(saw_broken, "the continuation sees broken_promise from a dropped promise");
+        check(is_broken_promise(next.get()), "broken_promise is delivered through then");
+    }
+
+    void when_all_in_order() {
+        std::vector<error_code_promise<int>> promises(3);
+        std::vector<error_code_future<int>> futures;
+        for (auto& promise : promises)
+            futures.push_back(promise.get_future());
+        auto all = when_all(std::move(futures));
+
+        // Complete out of order.
+        promises[2].set_value(2);
+        promises[0].set_value(0);
+        check(!all.ready(), "when_all waits for every input");
+        promises[1].set_value(1);
+
+        auto const result = all.get();
+        check(result and result.value() == std::vector<int>({0, 1, 2}), "when_all returns values in input order");
+    }
+
+    void when_all_first_error() {
+        std::vector<error_code_promise<int>> promises(3);
+        std::vector<error_code_future<int>> futures;
+        for (auto& promise : promises)
+            futures.push_back(promise.get_future());
+        auto all = when_all(std::move(futures));
+
+        promises[0].set_value(0);
+        promises[2].set_error(std::make_error_code(std::errc::io_error));
+        check(all.ready(), "when_all completes on the first error");
+        promises[1].set_error(std::make_error_code(std::errc::invalid_argument));
+
+        auto const result = all.get();
+        check(!result and result.error() == std::errc::io_error, "when_all returns the first error to arrive");
+    }
+
+    void when_all_empty() {
+        auto all = when_all(std::vector<error_code_future<int>>());
+        check(all.ready(), "when_all of no futures is ready");
+        auto const result = all.get();
+        check(result and result.value().empty(), "when_all of no futures is an empty vector");
+    }
+
+} // namespace
+
+int main() {
+
+    then_when_ready();
+    then_when_pending();
+    dropped_promise();
+    when_all_in_order();
+    when_all_first_error();
+    when_all_empty();
+
+    if (failures) {
+        std::printf("%d result_future checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All result_future checks passed\n");
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,119 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Checks how retry_on_transient decides whether, and how often, to
+// retry. The checks report by exit status.
+
+#include <cstdio>
+#include <cstdlib>
+
+#include "../converters.hpp"
+
+using namespace acm;
+
+namespace {
+
+    int failures = 0;
+
+    void check(bool condition, char const* what) {
+        if (!condition) {
+            std::printf("FAILED: %s\n", what);
+            ++failures;
+        }
+    }
+
+    int attempts = 0;
+    int fail_first = 0;
+    std::errc fail_with = std::errc::resource_unavailable_try_again;
+
+    // Fails the first fail_first attempts with fail_with, then returns
+    // its argument.
+    error_code_or<int> flaky(int val) {
+        if (attempts++ < fail_first)
+            return std::make_error_code(fail_with);
+        return val;
+    }
+
+    void reset(int failing, std::errc error) {
+        attempts = 0;
+        fail_first = failing;
+        fail_with = error;
+    }
+
+    void retries_until_success() {
+        reset(20, std::errc::resource_unavailable_try_again);
+        retry_stats stats;
+        auto const wrapped = retry_on_transient(flaky, retry_policy(), &stats);
+
+        auto const result = wrapped(7);
+        check(result and result.value() == 7, "a transient error is retried until success");
+        check(attempts == 21, "every failure is followed by one more attempt");
+        check(stats.calls == 1, "one call is recorded");
+        check(stats.retries == 20, "retries counts each attempt after the first");
+        check(stats.spins + stats.yields + stats.sleeps == stats.retries, "every retry waits in exactly one phase");
+        check(stats.deadlines_exceeded == 0, "no deadline is exceeded");
+    }
+
+    void non_retryable_error() {
+        reset(1, std::errc::io_error);
+        retry_stats stats;
+        auto const wrapped = retry_on_transient(flaky, retry_policy(), &stats);
+
+        auto const result = wrapped(7);
+        check(!result and result.error() == std::errc::io_error, "a non-retryable error is returned");
+        check(attempts == 1, "a non-retryable error makes one attempt");
+        check(stats.retries == 0, "a non-retryable error is not retried");
+    }
+
+    void custom_conditions() {
+        reset(2, std::errc::io_error);
+        retry_stats stats;
+        auto const wrapped = retry_on_transient(flaky, retry_policy{std::errc::io_error}, &stats);
+
+        auto const result = wrapped(7);
+        check(result and attempts == 3, "a configured condition is retried");
+        check(stats.retries == 2, "retries are counted for configured conditions");
+    }
+
+    void zero_deadline() {
+        reset(1000000, std::errc::resource_unavailable_try_again);
+        retry_policy policy;
+        policy.deadline = std::chrono::microseconds(0);
+        retry_stats stats;
+        auto const wrapped = retry_on_transient(flaky, policy, &stats);
+
+        auto const result = wrapped(7);
+        check(!result and result.error() == std::errc::resource_unavailable_try_again,
+              "the last error is returned once the deadline passes");
+        check(attempts == 1, "a zero deadline makes exactly one attempt");
+        check(stats.retries == 0, "a zero deadline makes no retries");
+        check(stats.deadlines_exceeded == 1, "the exceeded deadline is recorded");
+    }
+
+} // namespace
+
+int main() {
+
+    retries_until_success();
+    non_retryable_error();
+    custom_conditions();
+    zero_deadline();
+
+    if (failures) {
+        std::printf("%d retry checks failed\n", failures);
+        return EXIT_FAILURE;
+    }
+    std::printf("All retry checks passed\n");
+    return EXIT_SUCCESS;
+}
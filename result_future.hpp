@@ -0,0 +1,432 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_71b9bdc1_b0a3_43c0_8176_20247a749837
+#define included_71b9bdc1_b0a3_43c0_8176_20247a749837
+
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "error_or.hpp"
+
+namespace acm {
+
+    template<typename E, typename T>
+    class result_future;
+
+    template<typename E, typename T>
+    class result_promise;
+
+    namespace detail {
+
+        // The state shared between a result_promise and its
+        // result_future. It is allocated once, with make_shared, and
+        // holds the result inline. Readiness is published through an
+        // atomic so that polling and continuation registration never
+        // take a lock; the mutex and condition variable are used only
+        // when a thread actually blocks in wait().
+        template<typename E, typename T>
+        class result_state final {
+
+        public:
+            using result_type = error_or<E, T>;
+
+            inline result_state() noexcept = default;
+
+            result_state(result_state const&) = delete;
+            result_state& operator=(result_state const&) = delete;
+
+            inline ~result_state() {
+                if (phase_.load(std::memory_order_relaxed) == ready)
+                    result().~result_type();
+            }
+
+            inline bool is_ready() const noexcept {
+                return phase_.load(std::memory_order_acquire) == ready;
+            }
+
+            inline void set(result_type value) {
+                new(&storage_) result_type(std::move(value));
+
+                int const previous = phase_.exchange(ready, std::memory_order_seq_cst);
+                assert(previous != ready);
+
+                if (previous == continued) {
+                    std::function<void()> continuation(std::move(continuation_));
+                    continuation_ = nullptr;
+                    continuation();
+                }
+
+                if (waiting_.load(std::memory_order_seq_cst)) {
+                    std::lock_guard<std::mutex> lock(mutex_);
+                    cv_.notify_all();
+                }
+            }
+
+            // Runs continuation once the result is set: inline if it
+            // already is, otherwise on the thread that sets it. At most
+            // one continuation may be registered.
+            inline void on_ready(std::function<void()> continuation) {
+                if (is_ready()) {
+                    continuation();
+                    return;
+                }
+
+                continuation_ = std::move(continuation);
+                int expected = pending;
+                if (!phase_.compare_exchange_strong(expected, continued, std::memory_order_acq_rel)) {
+                    // The result arrived while we were registering.
+                    std::function<void()> run(std::move(continuation_));
+                    continuation_ = nullptr;
+                    run();
+                }
+            }
+
+            inline void wait() {
+                if (is_ready())
+                    return;
+
+                waiting_.store(true, std::memory_order_seq_cst);
+                std::unique_lock<std::mutex> lock(mutex_);
+                cv_.wait(lock, [this]() { return phase_.load(std::memory_order_seq_cst) == ready; });
+            }
+
+            inline result_type& result() noexcept {
+                return *reinterpret_cast<result_type*>(&storage_);
+            }
+
+        private:
+            enum : int { pending, continued, ready };
+
+            std::atomic<int> phase_{pending};
+            std::atomic<bool> waiting_{false};
+            typename std::aligned_storage<sizeof(result_type), alignof(result_type)>::type storage_;
+            std::function<void()> continuation_;
+            std::mutex mutex_;
+            std::condition_variable cv_;
+        };
+
+        template<typename E, bool = std::is_constructible<E, std::error_code>::value>
+        struct broken_promise {
+            static constexpr bool reportable = true;
+            static E error() {
+                return E(std::make_error_code(std::future_errc::broken_promise));
+            }
+        };
+
+        template<typename E>
+        struct broken_promise<E, false> {
+            static constexpr bool reportable = false;
+            static E error();
+        };
+
+        // Completes a state with broken_promise if destroyed while it
+        // still holds it. std::function requires its target to be
+        // copyable, so the guard is, but the continuation holding it is
+        // only ever moved; a copy would report twice.
+        template<typename E, typename T>
+        class broken_promise_guard final {
+
+        public:
+            inline explicit broken_promise_guard(std::shared_ptr<result_state<E, T>> state) noexcept
+                : state_(std::move(state)) {}
+
+            broken_promise_guard(broken_promise_guard const&) = default;
+            broken_promise_guard(broken_promise_guard&&) noexcept = default;
+
+            inline ~broken_promise_guard() {
+                if (state_)
+                    state_->set(broken_promise<E>::error());
+            }
+
+            inline std::shared_ptr<result_state<E, T>> release() noexcept {
+                return std::move(state_);
+            }
+
+        private:
+            std::shared_ptr<result_state<E, T>> state_;
+        };
+
+        // The continuation registered by result_future::then. It owns the
+        // source state until it runs, and completes the next state with
+        // what f returns, or with broken_promise if f throws or the
+        // continuation is destroyed without running.
+        template<typename E, typename T, typename U, typename F>
+        class continuation final {
+
+        public:
+            inline continuation(std::shared_ptr<result_state<E, T>> source, std::shared_ptr<result_state<E, U>> next, F f)
+                : source_(std::move(source))
+                , next_(std::move(next))
+                , f_(std::move(f)) {}
+
+            inline void operator()() {
+                error_or<E, U> result = f_(std::move(source_->result()));
+                source_.reset();
+                next_.release()->set(std::move(result));
+            }
+
+        private:
+            std::shared_ptr<result_state<E, T>> source_;
+            broken_promise_guard<E, U> next_;
+            F f_;
+        };
+
+        template<typename Result>
+        struct result_traits;
+
+        template<typename E, typename T>
+        struct result_traits<error_or<E, T>> {
+            using error_type = E;
+            using value_type = T;
+        };
+
+    } // namespace detail
+
+    // The consuming end of a result_promise. Unlike std::future, a
+    // failure is delivered as the error half of an error_or rather than
+    // as an exception, so nothing is thrown or rethrown.
+    template<typename E, typename T>
+    class result_future final {
+
+    public:
+        using error_type = E;
+        using value_type = T;
+        using result_type = error_or<E, T>;
+
+        inline result_future() noexcept = default;
+
+        inline bool valid() const noexcept {
+            return static_cast<bool>(state_);
+        }
+
+        inline bool ready() const noexcept {
+            assert(valid());
+            return state_->is_ready();
+        }
+
+        inline void wait() const {
+            assert(valid());
+            state_->wait();
+        }
+
+        // Blocks until the result is available and moves it out,
+        // leaving this future invalid.
+        inline result_type get() {
+            assert(valid());
+            state_->wait();
+            auto state = std::move(state_);
+            return std::move(state->result());
+        }
+
+        // Arranges for f to be called with the result, and returns a
+        // future for what f returns, which must itself be an error_or
+        // with the same error type. If the result is already available
+        // f runs immediately on this thread; otherwise it runs on the
+        // thread that fulfills the promise. This future is left invalid.
+        //
+        // E must be constructible from std::error_code, so that an
+        // abandoned promise still completes the chain with
+        // broken_promise rather than leaving it waiting forever.
+        template<typename F>
+        auto then(F f) -> result_future<E, typename detail::result_traits<typename std::result_of<F(result_type)>::type>::value_type> {
+            using next_result_type = typename std::result_of<F(result_type)>::type;
+            using next_value_type = typename detail::result_traits<next_result_type>::value_type;
+            static_assert(std::is_same<typename detail::result_traits<next_result_type>::error_type, E>::value,
+                          "continuation must return an error_or with the same error type");
+            static_assert(detail::broken_promise<E>::reportable,
+                          "then requires an error type constructible from std::error_code");
+
+            assert(valid());
+            auto next = std::make_shared<detail::result_state<E, next_value_type>>();
+            result_future<E, next_value_type> future(next);
+            auto state = std::move(state_);
+            auto& source = *state;
+
+            // The continuation owns the source state until it runs;
+            // once run it is destroyed, so no cycle outlives the result.
+            source.on_ready(detail::continuation<E, T, next_value_type, F>(std::move(state), std::move(next), std::move(f)));
+            return future;
+        }
+
+    private:
+        friend class result_promise<E, T>;
+
+        template<typename E2, typename T2>
+        friend class result_future;
+
+        template<typename E2, typename T2>
+        friend result_future<E2, std::vector<T2>> when_all(std::vector<result_future<E2, T2>> futures);
+
+        using state_type = detail::result_state<E, T>;
+
+        inline explicit result_future(std::shared_ptr<state_type> state) noexcept
+            : state_(std::move(state)) {}
+
+        std::shared_ptr<state_type> state_;
+    };
+
+    // The producing end of a result_future. The result may be set once.
+    // If the promise is destroyed without a result and the error type is
+    // constructible from std::error_code, the future receives
+    // std::future_errc::broken_promise. For any other error type every
+    // promise must be fulfilled; abandoning one whose future was
+    // retrieved is a logic error and asserts.
+    template<typename E, typename T>
+    class result_promise final {
+
+    public:
+        using error_type = E;
+        using value_type = T;
+        using result_type = error_or<E, T>;
+
+        inline result_promise()
+            : state_(std::make_shared<state_type>()) {}
+
+        result_promise(result_promise const&) = delete;
+        result_promise& operator=(result_promise const&) = delete;
+
+        inline result_promise(result_promise&& other) noexcept
+            : state_(std::move(other.state_))
+            , retrieved_(other.retrieved_)
+            , satisfied_(other.satisfied_) {}
+
+        inline result_promise& operator=(result_promise&& other) noexcept {
+            result_promise(std::move(other)).swap(*this);
+            return *this;
+        }
+
+        inline ~result_promise() {
+            if (state_ and !satisfied_)
+                abandon(std::integral_constant<bool, detail::broken_promise<E>::reportable>());
+        }
+
+        inline void swap(result_promise& other) noexcept {
+            using std::swap;
+            swap(state_, other.state_);
+            swap(retrieved_, other.retrieved_);
+            swap(satisfied_, other.satisfied_);
+        }
+
+        // May be called once.
+        inline result_future<E, T> get_future() {
+            assert(state_ and !retrieved_);
+            retrieved_ = true;
+            return result_future<E, T>(state_);
+        }
+
+        inline void set_result(result_type result) {
+            assert(state_ and !satisfied_);
+            satisfied_ = true;
+            state_->set(std::move(result));
+        }
+
+        inline void set_value(value_type value) {
+            set_result(result_type(std::move(value)));
+        }
+
+        inline void set_error(error_type error) {
+            set_result(result_type(std::move(error)));
+        }
+
+    private:
+        using state_type = detail::result_state<E, T>;
+
+        inline void abandon(std::true_type) {
+            set_error(detail::broken_promise<E>::error());
+        }
+
+        inline void abandon(std::false_type) {
+            assert(!retrieved_ && "result_promise destroyed without a result");
+        }
+
+        std::shared_ptr<state_type> state_;
+        bool retrieved_ = false;
+        bool satisfied_ = false;
+    };
+
+    // Returns a future that becomes ready with every value, in order,
+    // once all of futures have values, or with the first error to arrive
+    // as soon as any of them fails. Each input is consumed. As with
+    // then, E must be constructible from std::error_code so that an
+    // abandoned input cannot leave the result waiting forever.
+    template<typename E, typename T>
+    result_future<E, std::vector<T>> when_all(std::vector<result_future<E, T>> futures) {
+
+        static_assert(detail::broken_promise<E>::reportable,
+                      "when_all requires an error type constructible from std::error_code");
+
+        using state_type = detail::result_state<E, T>;
+
+        struct aggregate {
+            std::vector<std::shared_ptr<state_type>> states;
+            result_promise<E, std::vector<T>> promise;
+            std::atomic<std::size_t> remaining;
+            std::atomic<bool> failed{false};
+        };
+
+        auto shared = std::make_shared<aggregate>();
+        auto future = shared->promise.get_future();
+
+        if (futures.empty()) {
+            shared->promise.set_value(std::vector<T>());
+            return future;
+        }
+
+        shared->states.reserve(futures.size());
+        for (auto& f : futures) {
+            assert(f.valid());
+            shared->states.push_back(std::move(f.state_));
+        }
+        shared->remaining.store(shared->states.size(), std::memory_order_relaxed);
+
+        for (auto const& state : shared->states) {
+            state_type* const raw = state.get();
+            raw->on_ready([shared, raw]() {
+                if (!raw->result()) {
+                    if (!shared->failed.exchange(true, std::memory_order_acq_rel))
+                        shared->promise.set_error(raw->result().release_error());
+                } else if (shared->remaining.fetch_sub(1, std::memory_order_acq_rel) == 1 and
+                           !shared->failed.load(std::memory_order_acquire)) {
+                    std::vector<T> values;
+                    values.reserve(shared->states.size());
+                    for (auto const& s : shared->states)
+                        values.push_back(s->result().release_value());
+                    shared->promise.set_value(std::move(values));
+                }
+            });
+        }
+
+        return future;
+    }
+
+    template<typename T>
+    using error_code_future = result_future<std::error_code, T>;
+
+    template<typename T>
+    using error_code_promise = result_promise<std::error_code, T>;
+
+} // namespace acm
+
+#endif // included_71b9bdc1_b0a3_43c0_8176_20247a749837
@@ -0,0 +1,180 @@
+// Copyright 2013 Andrew C. Morrow
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#ifndef included_ad63665a_2e88_4dcf_8761_cd2ec68fa43e
+#define included_ad63665a_2e88_4dcf_8761_cd2ec68fa43e
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <future>
+#include <ios>
+#include <mutex>
+#include <system_error>
+#include <type_traits>
+
+#include "error_or.hpp"
+
+namespace acm {
+
+    // Maps error categories to identifiers that mean the same thing in
+    // every process, since a std::error_category address does not.
+    // Identifier 0 is reserved; the standard categories are
+    // preregistered as 1 (generic), 2 (system), 3 (iostream) and 4
+    // (future). Every process sharing encoded data must register its
+    // own categories under the same identifiers before use.
+    //
+    // Registration takes a lock. Lookups do not, so encoding and
+    // decoding never contend with each other.
+    class error_category_registry final {
+
+    public:
+        static std::size_t constexpr capacity = 64;
+
+        static std::uint32_t constexpr generic_id = 1;
+        static std::uint32_t constexpr system_id = 2;
+        static std::uint32_t constexpr iostream_id = 3;
+        static std::uint32_t constexpr future_id = 4;
+
+        static inline error_category_registry& instance() {
+            static error_category_registry registry;
+            return registry;
+        }
+
+        // Fails with invalid_argument for identifier 0, file_exists if
+        // the identifier or the category is already registered to
+        // something else, and no_buffer_space when the registry is full.
+        inline std::error_code register_category(std::uint32_t id, std::error_category const& category) {
+            if (id == 0)
+                return std::make_error_code(std::errc::invalid_argument);
+
+            std::lock_guard<std::mutex> lock(mutex_);
+            std::size_t const size = size_.load(std::memory_order_relaxed);
+            for (std::size_t i = 0; i != size; ++i) {
+                if (entries_[i].id == id or entries_[i].category == &category) {
+                    if (entries_[i].id == id and entries_[i].category == &category)
+                        return std::error_code();
+                    return std::make_error_code(std::errc::file_exists);
+                }
+            }
+            if (size == capacity)
+                return std::make_error_code(std::errc::no_buffer_space);
+
+            entries_[size].id = id;
+            entries_[size].category = &category;
+            size_.store(size + 1, std::memory_order_release);
+            return std::error_code();
+        }
+
+        // Returns 0 if the category has not been registered.
+        inline std::uint32_t id_of(std::error_category const& category) const noexcept {
+            std::size_t const size = size_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i != size; ++i)
+                if (entries_[i].category == &category)
+                    return entries_[i].id;
+            return 0;
+        }
+
+        // Returns nullptr if the identifier has not been registered.
+        inline std::error_category const* category_of(std::uint32_t id) const noexcept {
+            std::size_t const size = size_.load(std::memory_order_acquire);
+            for (std::size_t i = 0; i != size; ++i)
+                if (entries_[i].id == id)
+                    return entries_[i].category;
+            return nullptr;
+        }
+
+    private:
+        inline error_category_registry() {
+            register_category(generic_id, std::generic_category());
+            register_category(system_id, std::system_category());
+            register_category(iostream_id, std::iostream_category());
+            register_category(future_id, std::future_category());
+        }
+
+        struct entry {
+            std::uint32_t id;
+            std::error_category const* category;
+        };
+
+        std::mutex mutex_;
+        std::atomic<std::size_t> size_{0};
+        entry entries_[capacity];
+    };
+
+    // A fixed layout, trivially copyable image of error_code_or<T>. It
+    // holds no pointers, so it may be memcpy'd between processes or
+    // constructed directly inside a shared memory mapping and read in
+    // place by another process. Both sides must agree on T and on
+    // endianness, which in practice means running on the same host.
+    template<typename T>
+    struct wire_error_code_or final {
+        static_assert(std::is_trivially_copyable<T>::value,
+                      "wire_error_code_or requires a trivially copyable value type");
+
+        // Zero when a value is held, otherwise the registered category id.
+        std::uint32_t category;
+        std::int32_t code;
+        T value;
+
+        inline bool ok() const noexcept {
+            return category == 0;
+        }
+    };
+
+    // Writes from into to. Fails with invalid_argument, leaving to
+    // untouched, if from holds an error whose category has not been
+    // registered. The whole record, padding included, is zeroed before
+    // the fields are filled, so no stale bytes are published.
+    template<typename T>
+    std::error_code encode(error_code_or<T> const& from, wire_error_code_or<T>& to) noexcept {
+        std::uint32_t id = 0;
+        if (!from.ok()) {
+            id = error_category_registry::instance().id_of(from.error().category());
+            if (id == 0)
+                return std::make_error_code(std::errc::invalid_argument);
+        }
+
+        std::memset(&to, 0, sizeof(to));
+        if (from.ok()) {
+            std::memcpy(&to.value, &from.value(), sizeof(to.value));
+        } else {
+            to.category = id;
+            to.code = from.error().value();
+        }
+        return std::error_code();
+    }
+
+    // Reconstructs to from an encoded image. Fails with
+    // invalid_argument, leaving to untouched, if the image names a
+    // category that has not been registered in this process or carries
+    // a zero error code.
+    template<typename T>
+    std::error_code decode(wire_error_code_or<T> const& from, error_code_or<T>& to) noexcept {
+        if (from.ok()) {
+            to = from.value;
+            return std::error_code();
+        }
+
+        std::error_category const* category = error_category_registry::instance().category_of(from.category);
+        if (!category or from.code == 0)
+            return std::make_error_code(std::errc::invalid_argument);
+        to = std::error_code(from.code, *category);
+        return std::error_code();
+    }
+
+} // namespace acm
+
+#endif // included_ad63665a_2e88_4dcf_8761_cd2ec68fa43e